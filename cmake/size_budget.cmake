@@ -0,0 +1,86 @@
+# Copyright (c) 2023-2025 The ZMK Contributors
+# SPDX-License-Identifier: MIT
+
+# Checks what a library contributes to the linked image against a RAM/flash
+# budget. Sizes are taken from the linker map, so only input sections kept
+# after --gc-sections are counted.
+#
+# Usage: cmake -DMAP_FILE=<zephyr.map> -DLIBRARY=<lib.a> -DROM_BUDGET=<bytes>
+#              -DRAM_BUDGET=<bytes> -P size_budget.cmake
+#
+# A budget of 0 only reports the size. Thread stacks (.noinit) and the trace
+# buffer are sized by their own Kconfig options, so they are reported
+# separately and not checked against the budget.
+
+if(NOT EXISTS ${MAP_FILE})
+  message(FATAL_ERROR "Linker map ${MAP_FILE} not found")
+endif()
+
+file(STRINGS ${MAP_FILE} map_lines)
+
+set(rom 0)
+set(ram 0)
+set(stacks 0)
+set(trace 0)
+set(in_map FALSE)
+set(section "")
+
+foreach(line IN LISTS map_lines)
+  # Discarded input sections are listed before the memory map
+  if(NOT in_map)
+    if(line MATCHES "^Linker script and memory map")
+      set(in_map TRUE)
+    endif()
+    continue()
+  endif()
+
+  # Input section line: " <name> 0x<addr> 0x<size> <file>", where a long
+  # name is printed on a line of its own followed by the rest
+  if(line MATCHES "^ ([.A-Za-z_][^ \t]*)$")
+    set(section ${CMAKE_MATCH_1})
+    continue()
+  elseif(line MATCHES "^ ([.A-Za-z_][^ \t]*)[ \t]+0x[0-9a-fA-F]+[ \t]+0x([0-9a-fA-F]+)[ \t]+(.+)$")
+    set(section ${CMAKE_MATCH_1})
+  elseif(NOT line MATCHES "^[ \t]+0x[0-9a-fA-F]+[ \t]+0x([0-9a-fA-F]+)[ \t]+(.+)$")
+    set(section "")
+    continue()
+  endif()
+
+  # The size and file are always the last two matched groups
+  if(CMAKE_MATCH_COUNT EQUAL 3)
+    set(hex ${CMAKE_MATCH_2})
+    set(file ${CMAKE_MATCH_3})
+  else()
+    set(hex ${CMAKE_MATCH_1})
+    set(file ${CMAKE_MATCH_2})
+  endif()
+
+  string(FIND "${file}" "${LIBRARY}(" pos)
+  if(section STREQUAL "" OR pos EQUAL -1)
+    continue()
+  endif()
+  math(EXPR bytes "0x${hex}")
+
+  if(section MATCHES "trackball_pim447_trace_buf")
+    math(EXPR trace "${trace} + ${bytes}")
+  elseif(section MATCHES "^\\.noinit")
+    math(EXPR stacks "${stacks} + ${bytes}")
+  elseif(section MATCHES "^\\.(bss|sbss)" OR section STREQUAL "COMMON")
+    math(EXPR ram "${ram} + ${bytes}")
+  elseif(section MATCHES "^\\.(s?data)")
+    math(EXPR rom "${rom} + ${bytes}")
+    math(EXPR ram "${ram} + ${bytes}")
+  elseif(section MATCHES "^\\.(debug|comment|note|ARM\\.attributes|symtab|strtab|shstrtab|group)")
+    # Not loaded on the target
+  else()
+    math(EXPR rom "${rom} + ${bytes}")
+  endif()
+  set(section "")
+endforeach()
+
+message(STATUS "${LIBRARY}: ROM ${rom}/${ROM_BUDGET} bytes, RAM ${ram}/${RAM_BUDGET} bytes "
+               "(not budgeted: stacks ${stacks} bytes, trace buffer ${trace} bytes)")
+
+if((ROM_BUDGET GREATER 0 AND rom GREATER ROM_BUDGET) OR (RAM_BUDGET GREATER 0 AND ram GREATER RAM_BUDGET))
+  message(FATAL_ERROR "${LIBRARY} exceeds its size budget")
+endif()
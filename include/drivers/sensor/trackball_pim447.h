@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2023-2025 The ZMK Contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/drivers/sensor.h>
+
+/**
+ * @brief Pimoroni PIM447 trackball sensor attributes
+ * @defgroup trackball_pim447_attrs Trackball PIM447 Attributes
+ * @{
+ */
+
+/** LED color, set with an array of three sensor_values (red, green, blue) */
+#define PIM447_ATTR_LED_RGB (SENSOR_ATTR_PRIV_START)
+/** Trackball mode, PIM447_MOVE or PIM447_SCROLL */
+#define PIM447_ATTR_MODE (SENSOR_ATTR_PRIV_START + 1)
+/** Worst-case read latency in microseconds (CONFIG_ZMK_TRACKBALL_PIM447_READ_STATS), set to reset */
+#define PIM447_ATTR_READ_LATENCY_MAX (SENSOR_ATTR_PRIV_START + 2)
+
+/** @} */
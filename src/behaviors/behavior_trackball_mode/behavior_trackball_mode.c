@@ -11,15 +11,15 @@
 #include <zmk/behavior.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/pointer_event.h>
+#include <zmk/events/layer_state_changed.h>
+#include <zmk/keymap.h>
 #include <zmk/endpoints.h> // Needed for device_is_ready check
-
-// Re-define custom attributes locally if not using a shared header
-// These MUST match the definitions in the driver
-#define PIM447_ATTR_LED_RGB (SENSOR_ATTR_PRIV_START)
-#define PIM447_ATTR_MODE (SENSOR_ATTR_PRIV_START + 1)
+#include <drivers/sensor/trackball_pim447.h>
 
 // Use Kconfig to control logging level
-#if CONFIG_ZMK_BEHAVIOR_TRACKBALL_MODE_DEBUG
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_MINIMAL)
+#define LOG_LEVEL LOG_LEVEL_NONE
+#elif CONFIG_ZMK_BEHAVIOR_TRACKBALL_MODE_DEBUG
 #define LOG_LEVEL LOG_LEVEL_DBG
 #else
 #define LOG_LEVEL CONFIG_ZMK_LOG_LEVEL
@@ -37,23 +37,155 @@ struct behavior_trackball_mode_config
     enum trackball_mode default_mode;
     uint8_t led_mode_move;
     uint8_t led_mode_scroll;
+    // Layer bitmasks resolved from devicetree at build time
+    zmk_keymap_layers_state_t scroll_layers;
+    zmk_keymap_layers_state_t move_layers;
 };
 
 struct behavior_trackball_mode_data
 {
-    enum trackball_mode mode;
+    enum trackball_mode mode;           // Mode selected with the &tb_mode binding
+    enum trackball_mode active_mode;    // Mode currently pushed to the driver
     const struct device *trackball_dev; // Keep track of the trackball device
+    const struct device *dev;           // Back-reference for the LED work handler
+    struct k_work led_work;             // Deferred LED update (I2C)
 };
 
+/**
+ * @brief Push the LED preset for the given mode to the trackball
+ *
+ * Performs blocking I2C, so it must not be called from the key path.
+ */
+static int trackball_mode_set_led(const struct device *dev, enum trackball_mode mode)
+{
+    struct behavior_trackball_mode_data *data = dev->data;
+    const struct behavior_trackball_mode_config *config = dev->config;
+    uint8_t led_color = (mode == TRACKBALL_MODE_MOVE) ? config->led_mode_move : config->led_mode_scroll;
+
+    // Map preset colors to RGB values
+    uint8_t red = 0, green = 0, blue = 0;
+    switch (led_color)
+    {
+    case 0: // OFF
+        // All zeros (default)
+        break;
+    case 1: // RED
+        red = 255;
+        break;
+    case 2: // GREEN
+        green = 255;
+        break;
+    case 3: // BLUE
+        blue = 255;
+        break;
+    case 4: // YELLOW
+        red = 255;
+        green = 255;
+        break;
+    case 5: // CYAN
+        green = 255;
+        blue = 255;
+        break;
+    case 6: // MAGENTA
+        red = 255;
+        blue = 255;
+        break;
+    case 7: // WHITE
+        red = 255;
+        green = 255;
+        blue = 255;
+        break;
+    default:
+        // Invalid color, use default
+        break;
+    }
+
+    // Use PIM447_ATTR_LED_RGB to set LED color
+    struct sensor_value rgb[3] = {
+        {.val1 = red, .val2 = 0},
+        {.val1 = green, .val2 = 0},
+        {.val1 = blue, .val2 = 0}};
+
+    // Channel is ignored by the driver for this custom attribute
+    int ret = sensor_attr_set(data->trackball_dev, SENSOR_CHAN_ALL, PIM447_ATTR_LED_RGB, rgb);
+    if (ret != 0)
+    {
+        LOG_ERR("Failed to set LED color using custom attribute: %d", ret);
+        return ret;
+    }
+
+    LOG_DBG("Trackball LED color set to %d", led_color);
+    return 0;
+}
+
+static void trackball_mode_led_work_handler(struct k_work *work)
+{
+    struct behavior_trackball_mode_data *data =
+        CONTAINER_OF(work, struct behavior_trackball_mode_data, led_work);
+
+    if (data->trackball_dev != NULL)
+    {
+        trackball_mode_set_led(data->dev, data->active_mode);
+    }
+}
+
+/**
+ * @brief Resolve the mode that should currently be active
+ *
+ * The highest active layer listed in scroll-layers or move-layers wins; if no
+ * mapped layer is active, the mode selected with the binding is used.
+ */
+static enum trackball_mode trackball_mode_resolve(const struct device *dev)
+{
+    struct behavior_trackball_mode_data *data = dev->data;
+    const struct behavior_trackball_mode_config *config = dev->config;
+    zmk_keymap_layers_state_t mapped =
+        zmk_keymap_layer_state() & (config->scroll_layers | config->move_layers);
+
+    if (mapped == 0)
+    {
+        return data->mode;
+    }
+
+    zmk_keymap_layers_state_t top = BIT(31 - __builtin_clz(mapped));
+    return (config->scroll_layers & top) ? TRACKBALL_MODE_SCROLL : TRACKBALL_MODE_MOVE;
+}
+
+/**
+ * @brief Apply the resolved mode to the driver
+ *
+ * The driver mode update is a plain field write; the LED update is deferred
+ * to the system work queue so no I2C happens in the caller's context.
+ */
+static void trackball_mode_apply(const struct device *dev)
+{
+    struct behavior_trackball_mode_data *data = dev->data;
+    enum trackball_mode mode = trackball_mode_resolve(dev);
+
+    if (mode == data->active_mode || data->trackball_dev == NULL)
+    {
+        return;
+    }
+
+    data->active_mode = mode;
+
+    struct sensor_value mode_val = {.val1 = (mode == TRACKBALL_MODE_SCROLL)}; // 0 for move, 1 for scroll
+    int ret = sensor_attr_set(data->trackball_dev, SENSOR_CHAN_ALL, PIM447_ATTR_MODE, &mode_val);
+    if (ret != 0)
+    {
+        LOG_ERR("Failed to set trackball driver mode: %d", ret);
+    }
+
+    k_work_submit(&data->led_work);
+}
+
 static int on_trackball_mode_binding_pressed(struct zmk_behavior_binding *binding,
                                              struct zmk_behavior_binding_event event)
 {
     const struct device *dev = zmk_behavior_get_binding_device(binding);
     struct behavior_trackball_mode_data *data = dev->data;
-    const struct behavior_trackball_mode_config *config = dev->config;
 
     uint8_t param = binding->param1;
-    bool mode_changed = false;
 
     // Determine the new mode based on the binding parameter
     switch (param)
@@ -67,101 +199,23 @@ static int on_trackball_mode_binding_pressed(struct zmk_behavior_binding *bindin
         {
             data->mode = TRACKBALL_MODE_MOVE;
         }
-        mode_changed = true;
         break;
     case 1: // Set to scroll mode
-        if (data->mode != TRACKBALL_MODE_SCROLL)
-        {
-            data->mode = TRACKBALL_MODE_SCROLL;
-            mode_changed = true;
-        }
+        data->mode = TRACKBALL_MODE_SCROLL;
         break;
     case 2: // Set to move mode
-        if (data->mode != TRACKBALL_MODE_MOVE)
-        {
-            data->mode = TRACKBALL_MODE_MOVE;
-            mode_changed = true;
-        }
+        data->mode = TRACKBALL_MODE_MOVE;
         break;
     default:
         LOG_ERR("Unknown trackball mode parameter: %d", param);
         return -ENOTSUP;
     }
 
-    // If mode changed, update driver and LED
-    if (mode_changed && data->trackball_dev != NULL && device_is_ready(data->trackball_dev))
-    {
-        // 1. Tell the driver the new mode
-        struct sensor_value mode_val = {.val1 = (data->mode == TRACKBALL_MODE_SCROLL)}; // 0 for move, 1 for scroll
-        int ret = sensor_attr_set(data->trackball_dev, SENSOR_CHAN_ALL, PIM447_ATTR_MODE, &mode_val);
-        if (ret != 0)
-        {
-            LOG_ERR("Failed to set trackball driver mode: %d", ret);
-        }
-
-        // 2. Set the LED color based on the new mode
-        uint8_t led_color = (data->mode == TRACKBALL_MODE_MOVE) ? config->led_mode_move : config->led_mode_scroll;
-
-        // Map preset colors to RGB values
-        uint8_t red = 0, green = 0, blue = 0;
-        switch (led_color)
-        {
-        case 0: // OFF
-            // All zeros (default)
-            break;
-        case 1: // RED
-            red = 255;
-            break;
-        case 2: // GREEN
-            green = 255;
-            break;
-        case 3: // BLUE
-            blue = 255;
-            break;
-        case 4: // YELLOW
-            red = 255;
-            green = 255;
-            break;
-        case 5: // CYAN
-            green = 255;
-            blue = 255;
-            break;
-        case 6: // MAGENTA
-            red = 255;
-            blue = 255;
-            break;
-        case 7: // WHITE
-            red = 255;
-            green = 255;
-            blue = 255;
-            break;
-        default:
-            // Invalid color, use default
-            break;
-        }
-
-        // Use PIM447_ATTR_LED_RGB to set LED color
-        struct sensor_value rgb[3] = {
-            {.val1 = red, .val2 = 0},
-            {.val1 = green, .val2 = 0},
-            {.val1 = blue, .val2 = 0}};
-
-        // Channel is ignored by the driver for this custom attribute
-        ret = sensor_attr_set(data->trackball_dev, SENSOR_CHAN_ALL, PIM447_ATTR_LED_RGB, rgb);
-        if (ret != 0)
-        {
-            LOG_ERR("Failed to set LED color using custom attribute: %d", ret);
-        }
-        else
-        {
-            LOG_DBG("Trackball mode changed to %s, LED color set to %d",
-                    data->mode == TRACKBALL_MODE_MOVE ? "MOVE" : "SCROLL",
-                    led_color);
-        }
-    }
+    // Update driver and LED if the effective mode changed
+    trackball_mode_apply(dev);
 
     // Report the current mode
-    LOG_INF("Trackball mode: %s", data->mode == TRACKBALL_MODE_MOVE ? "MOVE" : "SCROLL");
+    LOG_INF("Trackball mode: %s", data->active_mode == TRACKBALL_MODE_MOVE ? "MOVE" : "SCROLL");
 
     return ZMK_BEHAVIOR_OPAQUE;
 }
@@ -179,6 +233,11 @@ static int behavior_trackball_mode_init(const struct device *dev)
 
     // Set the initial mode from device tree configuration
     data->mode = config->default_mode;
+    data->dev = dev;
+
+    // Layers active at boot (e.g. the default layer) may already select a mode
+    data->active_mode = trackball_mode_resolve(dev);
+    k_work_init(&data->led_work, trackball_mode_led_work_handler);
 
     // Try to find the trackball device - this behavior depends on the driver via Kconfig
     // so the chosen device should exist if this behavior is enabled.
@@ -198,7 +257,7 @@ static int behavior_trackball_mode_init(const struct device *dev)
         LOG_INF("Found trackball device: %s. Initializing driver mode and LED.", data->trackball_dev->name);
 
         // 1. Set initial driver mode
-        struct sensor_value mode_val = {.val1 = (data->mode == TRACKBALL_MODE_SCROLL)}; // 0 for move, 1 for scroll
+        struct sensor_value mode_val = {.val1 = (data->active_mode == TRACKBALL_MODE_SCROLL)}; // 0 for move, 1 for scroll
         int ret = sensor_attr_set(data->trackball_dev, SENSOR_CHAN_ALL, PIM447_ATTR_MODE, &mode_val);
         if (ret != 0)
         {
@@ -206,63 +265,12 @@ static int behavior_trackball_mode_init(const struct device *dev)
             // Continue anyway, maybe LED will work
         }
 
-        // 2. Set initial LED color based on the default mode
-        uint8_t led_color = (data->mode == TRACKBALL_MODE_MOVE) ? config->led_mode_move : config->led_mode_scroll;
-
-        // Map preset colors to RGB values
-        uint8_t red = 0, green = 0, blue = 0;
-        switch (led_color)
-        {
-        case 0: // OFF
-            // All zeros (default)
-            break;
-        case 1: // RED
-            red = 255;
-            break;
-        case 2: // GREEN
-            green = 255;
-            break;
-        case 3: // BLUE
-            blue = 255;
-            break;
-        case 4: // YELLOW
-            red = 255;
-            green = 255;
-            break;
-        case 5: // CYAN
-            green = 255;
-            blue = 255;
-            break;
-        case 6: // MAGENTA
-            red = 255;
-            blue = 255;
-            break;
-        case 7: // WHITE
-            red = 255;
-            green = 255;
-            blue = 255;
-            break;
-        default:
-            // Invalid color, use default
-            break;
-        }
-
-        // Set the initial LED color using custom attribute
-        struct sensor_value rgb[3] = {
-            {.val1 = red, .val2 = 0},
-            {.val1 = green, .val2 = 0},
-            {.val1 = blue, .val2 = 0}};
-
-        // Channel is ignored by the driver for this custom attribute
-        ret = sensor_attr_set(data->trackball_dev, SENSOR_CHAN_ALL, PIM447_ATTR_LED_RGB, rgb);
-        if (ret != 0)
-        {
-            LOG_ERR("Failed to set initial LED color using custom attribute: %d", ret);
-        }
+        // 2. Set initial LED color based on the initial mode
+        trackball_mode_set_led(dev, data->active_mode);
     }
 
-    LOG_INF("Trackball mode behavior initialized, default mode: %s",
-            data->mode == TRACKBALL_MODE_MOVE ? "MOVE" : "SCROLL");
+    LOG_INF("Trackball mode behavior initialized, mode: %s",
+            data->active_mode == TRACKBALL_MODE_MOVE ? "MOVE" : "SCROLL");
 
     return 0;
 }
@@ -273,10 +281,29 @@ static const struct behavior_driver_api behavior_trackball_mode_driver_api = {
     .binding_released = on_trackball_mode_binding_released,
 };
 
+// Fold a devicetree layer list into a layer-state bitmask at build time
+#define TB_LAYER_BIT(node_id, prop, idx) BIT(DT_PROP_BY_IDX(node_id, prop, idx)) |
+#define TB_LAYER_MASK(n, prop)                                                                \
+    COND_CODE_1(DT_INST_NODE_HAS_PROP(n, prop),                                               \
+                ((DT_INST_FOREACH_PROP_ELEM(n, prop, TB_LAYER_BIT) 0)), (0))
+
+// Every listed layer must exist in the keymap and fit in the layer-state mask
+#define TB_LAYER_CHECK(node_id, prop, idx)                                                    \
+    BUILD_ASSERT(DT_PROP_BY_IDX(node_id, prop, idx) < ZMK_KEYMAP_LAYERS_LEN &&                \
+                     DT_PROP_BY_IDX(node_id, prop, idx) < 8 * sizeof(zmk_keymap_layers_state_t), \
+                 "Trackball mode layer index out of range: " #prop);
+#define TB_LAYER_CHECKS(n, prop)                                                              \
+    COND_CODE_1(DT_INST_NODE_HAS_PROP(n, prop),                                               \
+                (DT_INST_FOREACH_PROP_ELEM(n, prop, TB_LAYER_CHECK)), ())
+
 // Device instance definition
 #define KP_INST(n)                                                                            \
+    TB_LAYER_CHECKS(n, scroll_layers)                                                         \
+    TB_LAYER_CHECKS(n, move_layers)                                                           \
+                                                                                              \
     static struct behavior_trackball_mode_data behavior_trackball_mode_data_##n = {           \
         .mode = TRACKBALL_MODE_MOVE, /* Default mode, overridden by config */                 \
+        .active_mode = TRACKBALL_MODE_MOVE,                                                   \
         .trackball_dev = NULL,                                                                \
     };                                                                                        \
                                                                                               \
@@ -284,6 +311,8 @@ static const struct behavior_driver_api behavior_trackball_mode_driver_api = {
         .default_mode = DT_INST_ENUM_IDX(n, default_mode),                                    \
         .led_mode_move = DT_INST_PROP_OR(n, led_mode_move, 2),     /* Default Green */        \
         .led_mode_scroll = DT_INST_PROP_OR(n, led_mode_scroll, 3), /* Default Blue */         \
+        .scroll_layers = TB_LAYER_MASK(n, scroll_layers),                                     \
+        .move_layers = TB_LAYER_MASK(n, move_layers),                                         \
     };                                                                                        \
                                                                                               \
     DEVICE_DT_INST_DEFINE(n, behavior_trackball_mode_init, NULL,                              \
@@ -292,4 +321,32 @@ static const struct behavior_driver_api behavior_trackball_mode_driver_api = {
                           CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,                                \
                           &behavior_trackball_mode_driver_api);
 
-DT_INST_FOREACH_STATUS_OKAY(KP_INST)
\ No newline at end of file
+DT_INST_FOREACH_STATUS_OKAY(KP_INST)
+
+#if DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT)
+
+#define TB_INST_DEV(n) DEVICE_DT_INST_GET(n),
+
+static const struct device *const behavior_trackball_mode_devs[] = {
+    DT_INST_FOREACH_STATUS_OKAY(TB_INST_DEV)};
+
+// Switch trackball profile when a mapped layer is activated or deactivated
+static int behavior_trackball_mode_layer_listener(const zmk_event_t *eh)
+{
+    if (as_zmk_layer_state_changed(eh) == NULL)
+    {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(behavior_trackball_mode_devs); i++)
+    {
+        trackball_mode_apply(behavior_trackball_mode_devs[i]);
+    }
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(behavior_trackball_mode, behavior_trackball_mode_layer_listener);
+ZMK_SUBSCRIPTION(behavior_trackball_mode, zmk_layer_state_changed);
+
+#endif /* DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT) */
\ No newline at end of file
@@ -6,15 +6,45 @@
 #define DT_DRV_COMPAT pimoroni_trackball_pim447
 
 #include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/drivers/sensor.h>
+#include <zephyr/input/input.h>
+#include <zephyr/dt-bindings/input/input-event-codes.h>
 #include <zephyr/sys/byteorder.h>
+#include <drivers/sensor/trackball_pim447.h>
 
-// Define custom sensor attributes (starting from private range)
-#define PIM447_ATTR_LED_RGB (SENSOR_ATTR_PRIV_START)
-#define PIM447_ATTR_MODE (SENSOR_ATTR_PRIV_START + 1)
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_SAMPLING_REPORT_RATE)
+#include <zmk/endpoints.h>
+#if IS_ENABLED(CONFIG_ZMK_BLE)
+#include <zephyr/bluetooth/conn.h>
+#include <zmk/ble.h>
+#endif
+#endif
 
+#include "trackball_pim447_trace.h"
+
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_TRACE)
+#include <zephyr/version.h>
+
+/*
+ * Frames handed to the input subsystem but not yet delivered. Each frame
+ * holds at least one slot of the input queue, and one more frame can be in
+ * delivery, so this bounds the frames in flight.
+ */
+#if IS_ENABLED(CONFIG_INPUT_MODE_THREAD)
+#define TRACKBALL_PIM447_TRACE_IN_FLIGHT (CONFIG_INPUT_QUEUE_MAX_MSGS + 1)
+#else
+#define TRACKBALL_PIM447_TRACE_IN_FLIGHT 1
+#endif
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_MINIMAL)
+#define LOG_LEVEL LOG_LEVEL_NONE
+#else
 #define LOG_LEVEL CONFIG_SENSOR_LOG_LEVEL
+#endif
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(trackball_pim447);
 
@@ -28,33 +58,75 @@ LOG_MODULE_REGISTER(trackball_pim447);
 #define TRACKBALL_PIM447_REG_DOWN 0x07
 #define TRACKBALL_PIM447_REG_SWITCH 0x08
 #define TRACKBALL_PIM447_REG_USER_FLASH 0xD0
+#define TRACKBALL_PIM447_REG_INT 0xF9
 
 /* Register ranges */
 #define TRACKBALL_PIM447_REG_MIN TRACKBALL_PIM447_REG_LEFT
 #define TRACKBALL_PIM447_REG_MAX TRACKBALL_PIM447_REG_SWITCH
+#define TRACKBALL_PIM447_REG_COUNT (TRACKBALL_PIM447_REG_MAX - TRACKBALL_PIM447_REG_MIN + 1)
+
+/* Switch register: bit 7 holds the current button state, bits 0-6 count state changes since the last read */
+#define TRACKBALL_PIM447_SWITCH_STATE BIT(7)
+#define TRACKBALL_PIM447_SWITCH_CHANGES BIT_MASK(7)
 
-/* Data structure */
+/* Interrupt register: drive the INT pin while motion data is pending */
+#define TRACKBALL_PIM447_INT_OUT_EN BIT(1)
+
+/* Work queue running trackball reads */
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_WORKQUEUE)
+K_THREAD_STACK_DEFINE(trackball_pim447_work_q_stack, CONFIG_ZMK_TRACKBALL_PIM447_WORKQUEUE_STACK_SIZE);
+static struct k_work_q trackball_pim447_work_q;
+#define TRACKBALL_PIM447_WORK_Q (&trackball_pim447_work_q)
+#else
+#define TRACKBALL_PIM447_WORK_Q (&k_sys_work_q)
+#endif
+
+/* Data structure, runtime state only (immutable settings stay in the config) */
 struct trackball_pim447_data
 {
-    const struct device *i2c_dev;
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_INPUT)
+    const struct device *dev;
+    struct k_work_delayable poll_work;
+    struct gpio_callback int_cb; /* Wakes sampling from idle when int-gpios is set */
+    int64_t last_activity;       /* Uptime of the last sample with motion or button activity, in ticks */
+#endif
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_SAMPLING_REPORT_RATE)
+    int64_t next_sample; /* Deadline of the next sample, in kernel ticks */
+#endif
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_READ_STATS)
+    int64_t sample_due;           /* Scheduled time of the pending sample, in ticks */
+    uint32_t read_latency_max_us; /* Worst-case delay from sample_due to read completion, in us.
+                                     32 bits, so attr_get never reads a torn value */
+#endif
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_TRACE)
+    uint16_t trace_seq; /* Sequence number of the current frame */
+    /* Sequence numbers of frames in the input queue, consumed on delivery. One spare slot tells full from empty */
+    uint16_t trace_in_flight[TRACKBALL_PIM447_TRACE_IN_FLIGHT + 1];
+    atomic_t trace_in_flight_head; /* Next slot to fill, written by the sampling thread */
+    atomic_t trace_in_flight_tail; /* Next slot to deliver, written by the input thread */
+#endif
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_SPLIT_COALESCE)
+    struct k_work_delayable flush_work; /* Forwards pending motion when the interval expires */
+    int64_t last_flush;                 /* Uptime of the last forwarded frame, in ticks */
+    int16_t pending_dx; /* Motion not yet forwarded to the central */
+    int16_t pending_dy;
+#endif
     int16_t dx;
     int16_t dy;
     uint8_t button_state;
-    bool invert_x;
-    bool invert_y;
-    uint8_t sensitivity;
-    uint8_t move_factor;
-    uint8_t scroll_factor;
-    uint8_t mode; /* 0=move, 1=scroll */
-    uint8_t led_red;
-    uint8_t led_green;
-    uint8_t led_blue;
+    bool read_failing; /* Last burst read failed, suppresses repeated errors */
+    /* Separate bytes: mode is written by attr_set, button_pressed by the sampling thread */
+    uint8_t mode;        /* 0=move, 1=scroll */
+    bool button_pressed; /* Last reported button state */
 };
 
 /* Configuration structure */
 struct trackball_pim447_config
 {
     struct i2c_dt_spec i2c;
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_INPUT)
+    struct gpio_dt_spec int_gpio; /* Optional, port is NULL when not wired */
+#endif
     uint8_t led_red;
     uint8_t led_green;
     uint8_t led_blue;
@@ -144,6 +216,73 @@ static int trackball_pim447_read_axis(const struct device *dev, uint8_t neg_reg,
     return 0;
 }
 
+/**
+ * @brief Read all motion and switch registers in a single transaction
+ *
+ * @param dev Device instance
+ * @param buf Buffer for registers TRACKBALL_PIM447_REG_MIN..TRACKBALL_PIM447_REG_MAX
+ * @return 0 on success, negative error code otherwise
+ */
+static int trackball_pim447_read_block(const struct device *dev, uint8_t buf[TRACKBALL_PIM447_REG_COUNT])
+{
+    const struct trackball_pim447_config *config = dev->config;
+    struct trackball_pim447_data *data = dev->data;
+    int err = 0;
+
+    err = i2c_burst_read_dt(&config->i2c, TRACKBALL_PIM447_REG_MIN, buf, TRACKBALL_PIM447_REG_COUNT);
+    if (err < 0)
+    {
+        /* Reads run periodically, so only log when the error state changes */
+        if (!data->read_failing)
+        {
+            LOG_ERR("Failed to read motion registers: %d", err);
+            data->read_failing = true;
+        }
+        return err;
+    }
+
+    if (data->read_failing)
+    {
+        LOG_INF("Motion register reads recovered");
+        data->read_failing = false;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Apply inversion, sensitivity and the mode factor to a raw axis value
+ *
+ * @param dev Device instance
+ * @param value Raw axis value
+ * @param invert Whether the axis is inverted
+ * @return Scaled axis value
+ */
+static int16_t trackball_pim447_scale(const struct device *dev, int16_t value, bool invert)
+{
+    const struct trackball_pim447_config *config = dev->config;
+    const struct trackball_pim447_data *data = dev->data;
+
+    /* Apply inversion if configured */
+    if (invert)
+    {
+        value = -value;
+    }
+
+    /* Scale by sensitivity - higher values = more movement */
+    value = (value * config->sensitivity) / 64;
+
+    /* Apply move/scroll factor based on mode */
+    if (data->mode == 0)
+    {
+        /* Move mode */
+        return value * config->move_factor;
+    }
+
+    /* Scroll mode */
+    return value * config->scroll_factor;
+}
+
 /**
  * @brief Set the LED color
  *
@@ -155,7 +294,6 @@ static int trackball_pim447_read_axis(const struct device *dev, uint8_t neg_reg,
  */
 static int trackball_pim447_set_led(const struct device *dev, uint8_t red, uint8_t green, uint8_t blue)
 {
-    struct trackball_pim447_data *data = dev->data;
     int err = 0;
 
     err = trackball_pim447_write_reg(dev, TRACKBALL_PIM447_REG_LED_RED, red);
@@ -176,11 +314,6 @@ static int trackball_pim447_set_led(const struct device *dev, uint8_t red, uint8
         return err;
     }
 
-    // Store the current LED color in our data structure
-    data->led_red = red;
-    data->led_green = green;
-    data->led_blue = blue;
-
     LOG_DBG("Set LED color to RGB(%d, %d, %d)", red, green, blue);
     return 0;
 }
@@ -194,11 +327,41 @@ static int trackball_pim447_set_led(const struct device *dev, uint8_t red, uint8
  */
 static int trackball_pim447_sample_fetch(const struct device *dev, enum sensor_channel chan)
 {
+    const struct trackball_pim447_config *config = dev->config;
     struct trackball_pim447_data *data = dev->data;
     int err = 0;
 
+    /* Read everything in one burst when all channels are requested */
+    if (chan == SENSOR_CHAN_ALL)
+    {
+        uint8_t regs[TRACKBALL_PIM447_REG_COUNT];
+
+        TRACKBALL_PIM447_TRACE(++data->trace_seq, TRACKBALL_PIM447_TRACE_FETCH_START);
+
+        err = trackball_pim447_read_block(dev, regs);
+        if (err < 0)
+        {
+            return err;
+        }
+
+        TRACKBALL_PIM447_TRACE(data->trace_seq, TRACKBALL_PIM447_TRACE_I2C_DONE);
+
+        data->dx = trackball_pim447_scale(dev,
+                                          (int16_t)regs[TRACKBALL_PIM447_REG_RIGHT - TRACKBALL_PIM447_REG_MIN] -
+                                              (int16_t)regs[TRACKBALL_PIM447_REG_LEFT - TRACKBALL_PIM447_REG_MIN],
+                                          config->invert_x);
+        data->dy = trackball_pim447_scale(dev,
+                                          (int16_t)regs[TRACKBALL_PIM447_REG_DOWN - TRACKBALL_PIM447_REG_MIN] -
+                                              (int16_t)regs[TRACKBALL_PIM447_REG_UP - TRACKBALL_PIM447_REG_MIN],
+                                          config->invert_y);
+        data->button_state = regs[TRACKBALL_PIM447_REG_SWITCH - TRACKBALL_PIM447_REG_MIN];
+
+        TRACKBALL_PIM447_TRACE(data->trace_seq, TRACKBALL_PIM447_TRACE_TRANSFORM_DONE);
+        return 0;
+    }
+
     /* Read X axis (horizontal) movement */
-    if (chan == SENSOR_CHAN_ALL || chan == SENSOR_CHAN_POS_DX)
+    if (chan == SENSOR_CHAN_POS_DX)
     {
         err = trackball_pim447_read_axis(dev,
                                          TRACKBALL_PIM447_REG_LEFT,
@@ -209,30 +372,11 @@ static int trackball_pim447_sample_fetch(const struct device *dev, enum sensor_c
             return err;
         }
 
-        /* Apply inversion if configured */
-        if (data->invert_x)
-        {
-            data->dx = -data->dx;
-        }
-
-        /* Scale by sensitivity - higher values = more movement */
-        data->dx = (data->dx * data->sensitivity) / 64;
-
-        /* Apply move/scroll factor based on mode */
-        if (data->mode == 0)
-        {
-            /* Move mode */
-            data->dx = data->dx * data->move_factor;
-        }
-        else
-        {
-            /* Scroll mode */
-            data->dx = data->dx * data->scroll_factor;
-        }
+        data->dx = trackball_pim447_scale(dev, data->dx, config->invert_x);
     }
 
     /* Read Y axis (vertical) movement */
-    if (chan == SENSOR_CHAN_ALL || chan == SENSOR_CHAN_POS_DY)
+    if (chan == SENSOR_CHAN_POS_DY)
     {
         err = trackball_pim447_read_axis(dev,
                                          TRACKBALL_PIM447_REG_UP,
@@ -243,30 +387,11 @@ static int trackball_pim447_sample_fetch(const struct device *dev, enum sensor_c
             return err;
         }
 
-        /* Apply inversion if configured */
-        if (data->invert_y)
-        {
-            data->dy = -data->dy;
-        }
-
-        /* Scale by sensitivity */
-        data->dy = (data->dy * data->sensitivity) / 64;
-
-        /* Apply move/scroll factor based on mode */
-        if (data->mode == 0)
-        {
-            /* Move mode */
-            data->dy = data->dy * data->move_factor;
-        }
-        else
-        {
-            /* Scroll mode */
-            data->dy = data->dy * data->scroll_factor;
-        }
+        data->dy = trackball_pim447_scale(dev, data->dy, config->invert_y);
     }
 
     /* Read button state */
-    if (chan == SENSOR_CHAN_ALL || chan == SENSOR_CHAN_PROX)
+    if (chan == SENSOR_CHAN_PROX)
     {
         uint8_t button = 0;
         err = trackball_pim447_read_reg(dev, TRACKBALL_PIM447_REG_SWITCH, &button);
@@ -366,6 +491,13 @@ static int trackball_pim447_attr_set(const struct device *dev, enum sensor_chann
         }
         break;
 
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_READ_STATS)
+    case PIM447_ATTR_READ_LATENCY_MAX:
+        // Any write resets the worst-case read latency
+        data->read_latency_max_us = 0;
+        break;
+#endif
+
     default:
         // Allow standard attributes if needed in the future, otherwise return error
         // if (chan == SENSOR_CHAN_PROX) { ... handle standard PROX attributes ... }
@@ -376,6 +508,482 @@ static int trackball_pim447_attr_set(const struct device *dev, enum sensor_chann
     return ret;
 }
 
+/**
+ * @brief Get attributes from the trackball
+ *
+ * @param dev Device instance
+ * @param chan The sensor channel (ignored for custom attributes)
+ * @param attr The attribute to get
+ * @param val Where to store the value
+ * @return 0 on success, negative error code otherwise
+ */
+static int trackball_pim447_attr_get(const struct device *dev, enum sensor_channel chan,
+                                     enum sensor_attribute attr, struct sensor_value *val)
+{
+    switch (attr)
+    {
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_READ_STATS)
+    case PIM447_ATTR_READ_LATENCY_MAX:
+    {
+        const struct trackball_pim447_data *data = dev->data;
+
+        // Worst-case read latency in microseconds
+        val->val1 = data->read_latency_max_us;
+        val->val2 = 0;
+        return 0;
+    }
+#endif
+
+    default:
+        return -ENOTSUP;
+    }
+}
+
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_INPUT)
+/**
+ * @brief Emit one frame to the input subsystem
+ *
+ * Motion is reported as X/Y in move mode and as wheel events in scroll mode.
+ * All events of one frame share a single sync so they land in one HID report.
+ *
+ * @param dev Device instance
+ * @param dx Horizontal motion
+ * @param dy Vertical motion
+ * @param button_changed Whether the button state changed
+ * @param pressed Current button state
+ */
+static void trackball_pim447_emit(const struct device *dev, int16_t dx, int16_t dy, bool button_changed,
+                                  bool pressed)
+{
+    struct trackball_pim447_data *data = dev->data;
+    bool has_motion = dx != 0 || dy != 0;
+
+    if (!button_changed && !has_motion)
+    {
+        return;
+    }
+
+    TRACKBALL_PIM447_TRACE(data->trace_seq, TRACKBALL_PIM447_TRACE_INPUT_REPORT);
+
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_TRACE)
+    /* Every emitted frame ends with exactly one sync event */
+    atomic_val_t head = atomic_get(&data->trace_in_flight_head);
+    atomic_val_t next = (head + 1) % (TRACKBALL_PIM447_TRACE_IN_FLIGHT + 1);
+
+    if (next == atomic_get(&data->trace_in_flight_tail))
+    {
+        TRACKBALL_PIM447_TRACE(data->trace_seq, TRACKBALL_PIM447_TRACE_INPUT_OVERFLOW);
+    }
+    else
+    {
+        data->trace_in_flight[head] = data->trace_seq;
+        /* atomic_set() is a full barrier, the slot is written before it is published */
+        atomic_set(&data->trace_in_flight_head, next);
+    }
+#endif
+
+    if (button_changed)
+    {
+        data->button_pressed = pressed;
+        input_report_key(dev, INPUT_BTN_0, pressed, !has_motion, K_FOREVER);
+    }
+
+    if (has_motion)
+    {
+        if (data->mode == 0)
+        {
+            input_report_rel(dev, INPUT_REL_X, dx, false, K_FOREVER);
+            input_report_rel(dev, INPUT_REL_Y, dy, true, K_FOREVER);
+        }
+        else
+        {
+            input_report_rel(dev, INPUT_REL_HWHEEL, dx, false, K_FOREVER);
+            input_report_rel(dev, INPUT_REL_WHEEL, -dy, true, K_FOREVER);
+        }
+    }
+
+    TRACKBALL_PIM447_TRACE(data->trace_seq, TRACKBALL_PIM447_TRACE_INPUT_QUEUED);
+}
+
+/**
+ * @brief Emit clicks that started and ended between two reads
+ *
+ * The current state only accounts for one change, or none if it matches the
+ * last reported state. Any further changes counted by the trackball come in
+ * press/release pairs, which are replayed as separate button frames.
+ *
+ * @param dev Device instance
+ * @param pressed Current button state
+ */
+static void trackball_pim447_emit_missed_clicks(const struct device *dev, bool pressed)
+{
+    struct trackball_pim447_data *data = dev->data;
+    uint8_t changes = data->button_state & TRACKBALL_PIM447_SWITCH_CHANGES;
+    uint8_t edge = pressed != data->button_pressed ? 1 : 0;
+    bool last = data->button_pressed;
+    uint8_t clicks = changes > edge ? (changes - edge) / 2 : 0;
+
+    for (uint8_t i = 0; i < clicks; i++)
+    {
+        trackball_pim447_emit(dev, 0, 0, true, !last);
+        trackball_pim447_emit(dev, 0, 0, true, last);
+    }
+}
+
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_SPLIT_COALESCE)
+/**
+ * @brief Forward the pending motion as one frame
+ *
+ * @param dev Device instance
+ * @param button_changed Whether the button state changed
+ * @param pressed Current button state
+ */
+static void trackball_pim447_flush(const struct device *dev, bool button_changed, bool pressed)
+{
+    struct trackball_pim447_data *data = dev->data;
+    int16_t dx = data->pending_dx;
+    int16_t dy = data->pending_dy;
+
+    if (!button_changed && dx == 0 && dy == 0)
+    {
+        return;
+    }
+
+    data->pending_dx = 0;
+    data->pending_dy = 0;
+    data->last_flush = k_uptime_ticks();
+
+    trackball_pim447_emit(dev, dx, dy, button_changed, pressed);
+}
+
+/**
+ * @brief Flush work handler, runs when the split interval since the last frame expires
+ *
+ * @param work Work item embedded in the driver data
+ */
+static void trackball_pim447_flush_work_handler(struct k_work *work)
+{
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct trackball_pim447_data *data = CONTAINER_OF(dwork, struct trackball_pim447_data, flush_work);
+
+    trackball_pim447_flush(data->dev, false, data->button_pressed);
+}
+#endif
+
+/**
+ * @brief Forward the last sample
+ *
+ * Clicks that fit entirely between two reads are replayed first, after any
+ * pending motion. On split peripherals with coalescing enabled, motion is
+ * summed and forwarded at most once per split interval by a timer, or right
+ * away on a button edge. The first motion after an idle period is forwarded
+ * immediately, so coalescing adds no latency to the start of a movement.
+ *
+ * @param dev Device instance
+ */
+static void trackball_pim447_report(const struct device *dev)
+{
+    struct trackball_pim447_data *data = dev->data;
+    bool pressed = (data->button_state & TRACKBALL_PIM447_SWITCH_STATE) != 0;
+
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_SPLIT_COALESCE)
+    if ((data->button_state & TRACKBALL_PIM447_SWITCH_CHANGES) > 1)
+    {
+        /* More than one change may include replayed clicks, keep the pending motion ahead of them */
+        k_work_cancel_delayable(&data->flush_work);
+        trackball_pim447_flush(dev, false, data->button_pressed);
+    }
+#endif
+    trackball_pim447_emit_missed_clicks(dev, pressed);
+
+    bool button_changed = pressed != data->button_pressed;
+
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_SPLIT_COALESCE)
+    int32_t sum_dx = (int32_t)data->pending_dx + data->dx;
+    int32_t sum_dy = (int32_t)data->pending_dy + data->dy;
+
+    /* Forward the pending motion first if adding this sample would overflow it */
+    if (sum_dx != (int16_t)sum_dx || sum_dy != (int16_t)sum_dy)
+    {
+        trackball_pim447_flush(dev, false, pressed);
+        sum_dx = data->dx;
+        sum_dy = data->dy;
+    }
+
+    data->pending_dx = sum_dx;
+    data->pending_dy = sum_dy;
+
+    if (button_changed)
+    {
+        k_work_cancel_delayable(&data->flush_work);
+        trackball_pim447_flush(dev, true, pressed);
+        return;
+    }
+
+    if (data->pending_dx == 0 && data->pending_dy == 0)
+    {
+        return;
+    }
+
+    int64_t due = data->last_flush + k_us_to_ticks_ceil64(CONFIG_ZMK_TRACKBALL_PIM447_SPLIT_INTERVAL_US);
+    int64_t now = k_uptime_ticks();
+
+    if (now >= due)
+    {
+        k_work_cancel_delayable(&data->flush_work);
+        trackball_pim447_flush(dev, false, pressed);
+        return;
+    }
+
+    /* Does nothing if the flush is already scheduled */
+    k_work_schedule_for_queue(TRACKBALL_PIM447_WORK_Q, &data->flush_work, K_TICKS(due - now));
+#else
+    trackball_pim447_emit(dev, data->dx, data->dy, button_changed, pressed);
+#endif
+}
+
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_TRACE)
+/**
+ * @brief Trace the delivery of a frame's sync event
+ *
+ * Runs on the input thread (or inline in synchronous input mode), alongside
+ * ZMK's input listener that builds and sends the HID report.
+ *
+ * @param evt Input event
+ */
+static void trackball_pim447_trace_input_delivered(struct input_event *evt)
+{
+    struct trackball_pim447_data *data = evt->dev->data;
+    atomic_val_t tail = atomic_get(&data->trace_in_flight_tail);
+
+    if (!evt->sync || tail == atomic_get(&data->trace_in_flight_head))
+    {
+        return;
+    }
+
+    TRACKBALL_PIM447_TRACE(data->trace_in_flight[tail], TRACKBALL_PIM447_TRACE_INPUT_DELIVERED);
+    atomic_set(&data->trace_in_flight_tail, (tail + 1) % (TRACKBALL_PIM447_TRACE_IN_FLIGHT + 1));
+}
+
+/* Input callbacks take a user data pointer since Zephyr 4.0 */
+#if ZEPHYR_VERSION_CODE >= ZEPHYR_VERSION(4, 0, 0)
+static void trackball_pim447_trace_input_cb(struct input_event *evt, void *user_data)
+{
+    trackball_pim447_trace_input_delivered(evt);
+}
+
+#define TRACKBALL_PIM447_TRACE_INPUT_CALLBACK(inst) \
+    INPUT_CALLBACK_DEFINE(DEVICE_DT_INST_GET(inst), trackball_pim447_trace_input_cb, NULL);
+#else
+#define TRACKBALL_PIM447_TRACE_INPUT_CALLBACK(inst) \
+    INPUT_CALLBACK_DEFINE(DEVICE_DT_INST_GET(inst), trackball_pim447_trace_input_delivered);
+#endif
+#else
+#define TRACKBALL_PIM447_TRACE_INPUT_CALLBACK(inst)
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_SAMPLING_REPORT_RATE)
+/**
+ * @brief Get the report interval of the active endpoint
+ *
+ * For BLE this is the connection interval negotiated with the host on the
+ * active profile. USB uses the Kconfig value.
+ *
+ * @return Interval in microseconds, 0 if the active endpoint is not connected
+ */
+static uint32_t trackball_pim447_report_interval_us(void)
+{
+    struct zmk_endpoint_instance endpoint = zmk_endpoints_selected();
+
+    if (endpoint.transport == ZMK_TRANSPORT_USB)
+    {
+        return CONFIG_ZMK_TRACKBALL_PIM447_USB_INTERVAL_US;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_BLE)
+    struct bt_conn *conn = bt_conn_lookup_addr_le(BT_ID_DEFAULT, zmk_ble_active_profile_addr());
+    if (conn != NULL)
+    {
+        struct bt_conn_info info;
+        int err = bt_conn_get_info(conn, &info);
+
+        bt_conn_unref(conn);
+        if (err == 0 && info.le.interval > 0)
+        {
+            /* Connection interval is in units of 1.25 ms */
+            return info.le.interval * 1250U;
+        }
+    }
+#endif
+
+    return 0;
+}
+#endif
+
+/**
+ * @brief Schedule the next sample
+ *
+ * After CONFIG_ZMK_TRACKBALL_PIM447_IDLE_TIMEOUT_MS without activity the
+ * trackball is idle: with int-gpios, sampling stops until the INT pin fires;
+ * without it, sampling slows down to CONFIG_ZMK_TRACKBALL_PIM447_IDLE_POLL_INTERVAL_MS.
+ *
+ * In report-rate mode samples run on a fixed grid with the report interval of
+ * the active endpoint, so there is one read per report. The host's slot phase
+ * is not observable, so the grid is not phase-aligned with the reports. If
+ * the schedule fell behind (or the interval changed), the grid is restarted.
+ * While the active endpoint is not connected there is nothing to report to,
+ * so sampling behaves as if idle.
+ *
+ * @param dev Device instance
+ */
+static void trackball_pim447_schedule(const struct device *dev)
+{
+    const struct trackball_pim447_config *config = dev->config;
+    struct trackball_pim447_data *data = dev->data;
+    bool idle = k_uptime_ticks() - data->last_activity >=
+                k_ms_to_ticks_ceil64(CONFIG_ZMK_TRACKBALL_PIM447_IDLE_TIMEOUT_MS);
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_SAMPLING_REPORT_RATE)
+    uint32_t interval_us = trackball_pim447_report_interval_us();
+
+    if (interval_us == 0)
+    {
+        idle = true;
+    }
+#endif
+
+    if (idle)
+    {
+        if (config->int_gpio.port != NULL)
+        {
+            /* Level-triggered, so data that arrived since the last read fires right away */
+            gpio_pin_interrupt_configure_dt(&config->int_gpio, GPIO_INT_LEVEL_ACTIVE);
+            return;
+        }
+
+        k_work_schedule_for_queue(TRACKBALL_PIM447_WORK_Q, &data->poll_work,
+                                  K_MSEC(CONFIG_ZMK_TRACKBALL_PIM447_IDLE_POLL_INTERVAL_MS));
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_READ_STATS)
+        data->sample_due = k_uptime_ticks() + k_ms_to_ticks_ceil64(CONFIG_ZMK_TRACKBALL_PIM447_IDLE_POLL_INTERVAL_MS);
+#endif
+        return;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_SAMPLING_REPORT_RATE)
+    int64_t interval = k_us_to_ticks_ceil64(interval_us);
+    int64_t now = k_uptime_ticks();
+
+    data->next_sample += interval;
+    if (data->next_sample <= now || data->next_sample - now > interval)
+    {
+        data->next_sample = now + interval;
+    }
+
+    k_work_schedule_for_queue(TRACKBALL_PIM447_WORK_Q, &data->poll_work,
+                              K_TIMEOUT_ABS_TICKS(data->next_sample));
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_READ_STATS)
+    data->sample_due = data->next_sample;
+#endif
+#else
+    k_work_schedule_for_queue(TRACKBALL_PIM447_WORK_Q, &data->poll_work,
+                              K_MSEC(CONFIG_ZMK_TRACKBALL_PIM447_POLL_INTERVAL_MS));
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_READ_STATS)
+    data->sample_due = k_uptime_ticks() + k_ms_to_ticks_ceil64(CONFIG_ZMK_TRACKBALL_PIM447_POLL_INTERVAL_MS);
+#endif
+#endif
+}
+
+/**
+ * @brief Periodic sampling work handler
+ *
+ * @param work Work item embedded in the driver data
+ */
+static void trackball_pim447_poll_work_handler(struct k_work *work)
+{
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct trackball_pim447_data *data = CONTAINER_OF(dwork, struct trackball_pim447_data, poll_work);
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_READ_STATS)
+    int64_t due = data->sample_due;
+#endif
+
+    if (trackball_pim447_sample_fetch(data->dev, SENSOR_CHAN_ALL) == 0)
+    {
+        /* A held button counts as activity, as do pending press counts */
+        if (data->dx != 0 || data->dy != 0 || data->button_state != 0)
+        {
+            data->last_activity = k_uptime_ticks();
+        }
+
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_READ_STATS)
+        /* Covers work queue wait, bus wait and the read itself */
+        uint32_t latency_us = k_ticks_to_us_ceil32(k_uptime_ticks() - due);
+        if (latency_us > data->read_latency_max_us)
+        {
+            data->read_latency_max_us = latency_us;
+            LOG_DBG("New worst-case read latency: %u us", latency_us);
+        }
+#endif
+        trackball_pim447_report(data->dev);
+    }
+
+    trackball_pim447_schedule(data->dev);
+}
+
+/**
+ * @brief INT pin handler, wakes sampling from idle
+ *
+ * @param port GPIO port
+ * @param cb Callback embedded in the driver data
+ * @param pins Triggering pins
+ */
+static void trackball_pim447_int_handler(const struct device *port, struct gpio_callback *cb,
+                                         gpio_port_pins_t pins)
+{
+    struct trackball_pim447_data *data = CONTAINER_OF(cb, struct trackball_pim447_data, int_cb);
+    const struct trackball_pim447_config *config = data->dev->config;
+
+    gpio_pin_interrupt_configure_dt(&config->int_gpio, GPIO_INT_DISABLE);
+    k_work_schedule_for_queue(TRACKBALL_PIM447_WORK_Q, &data->poll_work, K_NO_WAIT);
+}
+
+/**
+ * @brief Set up the INT pin and enable the trackball's interrupt output
+ *
+ * @param dev Device instance
+ * @return 0 on success, negative error code otherwise
+ */
+static int trackball_pim447_init_int(const struct device *dev)
+{
+    const struct trackball_pim447_config *config = dev->config;
+    struct trackball_pim447_data *data = dev->data;
+    int err = 0;
+
+    if (!gpio_is_ready_dt(&config->int_gpio))
+    {
+        LOG_ERR("INT GPIO not ready");
+        return -ENODEV;
+    }
+
+    err = gpio_pin_configure_dt(&config->int_gpio, GPIO_INPUT);
+    if (err < 0)
+    {
+        LOG_ERR("Failed to configure INT GPIO: %d", err);
+        return err;
+    }
+
+    gpio_init_callback(&data->int_cb, trackball_pim447_int_handler, BIT(config->int_gpio.pin));
+    err = gpio_add_callback_dt(&config->int_gpio, &data->int_cb);
+    if (err < 0)
+    {
+        LOG_ERR("Failed to add INT GPIO callback: %d", err);
+        return err;
+    }
+
+    return trackball_pim447_write_reg(dev, TRACKBALL_PIM447_REG_INT, TRACKBALL_PIM447_INT_OUT_EN);
+}
+#else
+#define TRACKBALL_PIM447_TRACE_INPUT_CALLBACK(inst)
+#endif /* IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_INPUT) */
+
 /**
  * @brief Initialize the trackball driver
  *
@@ -395,12 +1003,6 @@ static int trackball_pim447_init(const struct device *dev)
         return -ENODEV;
     }
 
-    /* Store configuration in runtime data */
-    data->invert_x = config->invert_x;
-    data->invert_y = config->invert_y;
-    data->sensitivity = config->sensitivity;
-    data->move_factor = config->move_factor;
-    data->scroll_factor = config->scroll_factor;
     data->mode = 0; // Default to move mode
 
     /* Set the initial LED color */
@@ -411,6 +1013,40 @@ static int trackball_pim447_init(const struct device *dev)
         return err;
     }
 
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_INPUT)
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_WORKQUEUE)
+    /* Start the shared work queue with the first instance */
+    static bool work_q_started;
+    if (!work_q_started)
+    {
+        k_work_queue_start(&trackball_pim447_work_q, trackball_pim447_work_q_stack,
+                           K_THREAD_STACK_SIZEOF(trackball_pim447_work_q_stack),
+                           CONFIG_ZMK_TRACKBALL_PIM447_WORKQUEUE_PRIORITY, NULL);
+        k_thread_name_set(&trackball_pim447_work_q.thread, "trackball_pim447");
+        work_q_started = true;
+    }
+#endif
+
+    /* Start sampling, active until the first idle timeout */
+    data->dev = dev;
+    data->last_activity = k_uptime_ticks();
+    k_work_init_delayable(&data->poll_work, trackball_pim447_poll_work_handler);
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_SPLIT_COALESCE)
+    k_work_init_delayable(&data->flush_work, trackball_pim447_flush_work_handler);
+#endif
+
+    if (config->int_gpio.port != NULL)
+    {
+        err = trackball_pim447_init_int(dev);
+        if (err < 0)
+        {
+            return err;
+        }
+    }
+
+    trackball_pim447_schedule(dev);
+#endif
+
     LOG_INF("Pimoroni Trackball initialized (addr: 0x%02x)", config->i2c.addr);
     return 0;
 }
@@ -420,6 +1056,7 @@ static const struct sensor_driver_api trackball_pim447_api = {
     .sample_fetch = trackball_pim447_sample_fetch,
     .channel_get = trackball_pim447_channel_get,
     .attr_set = trackball_pim447_attr_set,
+    .attr_get = trackball_pim447_attr_get,
 };
 
 /* Driver initialization */
@@ -428,6 +1065,8 @@ static const struct sensor_driver_api trackball_pim447_api = {
                                                                                           \
     static const struct trackball_pim447_config trackball_pim447_config_##inst = {        \
         .i2c = I2C_DT_SPEC_INST_GET(inst),                                                \
+        IF_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_INPUT,                                     \
+                   (.int_gpio = GPIO_DT_SPEC_INST_GET_OR(inst, int_gpios, {0}), ))        \
         .led_red = DT_INST_PROP_OR(inst, led_red, 0),                                     \
         .led_green = DT_INST_PROP_OR(inst, led_green, 0),                                 \
         .led_blue = DT_INST_PROP_OR(inst, led_blue, 0),                                   \
@@ -440,6 +1079,8 @@ static const struct sensor_driver_api trackball_pim447_api = {
                                                                                           \
     DEVICE_DT_INST_DEFINE(inst, trackball_pim447_init, NULL,                              \
                           &trackball_pim447_data_##inst, &trackball_pim447_config_##inst, \
-                          POST_KERNEL, CONFIG_SENSOR_INIT_PRIORITY, &trackball_pim447_api);
+                          POST_KERNEL, CONFIG_SENSOR_INIT_PRIORITY, &trackball_pim447_api); \
+                                                                                          \
+    TRACKBALL_PIM447_TRACE_INPUT_CALLBACK(inst)
 
 DT_INST_FOREACH_STATUS_OKAY(TRACKBALL_PIM447_INIT)
\ No newline at end of file
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2023-2025 The ZMK Contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include "trackball_pim447_trace.h"
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_ZMK_TRACKBALL_PIM447_TRACE_ENTRIES),
+             "Trace buffer size must be a power of two");
+
+struct trackball_pim447_trace_entry trackball_pim447_trace_buf[CONFIG_ZMK_TRACKBALL_PIM447_TRACE_ENTRIES];
+atomic_t trackball_pim447_trace_head = ATOMIC_INIT(0);
+
+void trackball_pim447_trace(uint16_t seq, enum trackball_pim447_trace_point point)
+{
+    atomic_val_t idx = atomic_inc(&trackball_pim447_trace_head);
+    struct trackball_pim447_trace_entry *entry =
+        &trackball_pim447_trace_buf[idx & (CONFIG_ZMK_TRACKBALL_PIM447_TRACE_ENTRIES - 1)];
+
+    entry->cycles = k_cycle_get_32();
+    entry->seq = seq;
+    entry->point = point;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2023-2025 The ZMK Contributors
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+
+/**
+ * @brief Trackball latency trace points, in pipeline order
+ *
+ * Every sample gets a frame sequence number, so entries with the same
+ * sequence number make up the latency breakdown of one frame.
+ */
+enum trackball_pim447_trace_point
+{
+    TRACKBALL_PIM447_TRACE_FETCH_START = 0,     /* Sample fetch started */
+    TRACKBALL_PIM447_TRACE_I2C_DONE = 1,        /* Burst read completed */
+    TRACKBALL_PIM447_TRACE_TRANSFORM_DONE = 2,  /* Scaling and inversion applied */
+    TRACKBALL_PIM447_TRACE_INPUT_REPORT = 3,    /* Handing events to the input subsystem */
+    TRACKBALL_PIM447_TRACE_INPUT_QUEUED = 4,    /* Input sync handed off (queued in threaded input mode) */
+    TRACKBALL_PIM447_TRACE_INPUT_DELIVERED = 5, /* Input sync delivered to input callbacks, next to ZMK's listener */
+    TRACKBALL_PIM447_TRACE_INPUT_OVERFLOW = 6,  /* Frame not tracked to delivery, in-flight queue full */
+};
+
+#if IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_TRACE)
+
+/* Trace ring buffer entry */
+struct trackball_pim447_trace_entry
+{
+    uint32_t cycles; /* k_cycle_get_32() timestamp */
+    uint16_t seq;    /* Frame sequence number */
+    uint8_t point;   /* enum trackball_pim447_trace_point */
+};
+
+/* Ring buffer, exported for debuggers and host-side tools */
+extern struct trackball_pim447_trace_entry trackball_pim447_trace_buf[CONFIG_ZMK_TRACKBALL_PIM447_TRACE_ENTRIES];
+
+/* Index of the next entry to be written, modulo the buffer size */
+extern atomic_t trackball_pim447_trace_head;
+
+/**
+ * @brief Record a trace point
+ *
+ * @param seq Frame sequence number
+ * @param point Trace point
+ */
+void trackball_pim447_trace(uint16_t seq, enum trackball_pim447_trace_point point);
+
+#define TRACKBALL_PIM447_TRACE(seq, point) trackball_pim447_trace((seq), (point))
+
+#else
+
+/* Arguments are not evaluated when tracing is disabled */
+#define TRACKBALL_PIM447_TRACE(seq, point) \
+    do                                     \
+    {                                      \
+    } while (0)
+
+#endif /* IS_ENABLED(CONFIG_ZMK_TRACKBALL_PIM447_TRACE) */